@@ -6,10 +6,13 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 
+#include "tic_tac_toe_policy.h"
+
 #define WINDOW_WIDTH 480
 #define WINDOW_HEIGHT 480
 #define CELL_SIZE 160
 #define BOARD_SIZE 3
+#define POLICY_FILE "tic_tac_toe_policy.bin"
 
 typedef enum {
     CELL_EMPTY = 0,
@@ -24,6 +27,11 @@ typedef enum {
     GAME_DRAW
 } GameState;
 
+typedef enum {
+    DIFFICULTY_NORMAL,  // Hand-tuned heuristics
+    DIFFICULTY_LEARNED  // Policy trained by tic_tac_toe_train
+} Difficulty;
+
 typedef struct {
     SDL_Window *window;
     SDL_Renderer *renderer;
@@ -32,6 +40,8 @@ typedef struct {
     int selected_row;
     int selected_col;
     Uint64 start_time;
+    Difficulty difficulty;
+    unsigned char *policy;  // NULL if no valid policy file was found
 } AppState;
 
 static int check_winner(AppState *app, CellState player) {
@@ -61,7 +71,28 @@ static int is_board_full(AppState *app) {
     return 1;
 }
 
+static int learned_move(AppState *app) {
+    // Encode the board in base 3 as the policy file expects
+    unsigned int state = 0;
+    for (int i = BOARD_SIZE * BOARD_SIZE - 1; i >= 0; i--) {
+        state = state * 3 + app->board[i / BOARD_SIZE][i % BOARD_SIZE];
+    }
+
+    int cell = policy_lookup(app->policy, state);
+    if (cell == POLICY_NO_MOVE || cell >= BOARD_SIZE * BOARD_SIZE ||
+        app->board[cell / BOARD_SIZE][cell % BOARD_SIZE] != CELL_EMPTY) {
+        return 0;
+    }
+    app->board[cell / BOARD_SIZE][cell % BOARD_SIZE] = CELL_MACHINE;
+    return 1;
+}
+
 static void machine_move(AppState *app) {
+    // Learned policy falls back to the heuristics below if it has no answer
+    if (app->difficulty == DIFFICULTY_LEARNED && app->policy && learned_move(app)) {
+        return;
+    }
+
     // Check if this is the first move (only player has moved)
     int total_moves = 0;
     for (int i = 0; i < BOARD_SIZE; i++) {
@@ -196,6 +227,31 @@ static void make_move(AppState *app, int row, int col) {
     }
 }
 
+static void load_policy(AppState *app) {
+    // Policy file lives next to the binary; without it only NORMAL is offered
+    const char *base = SDL_GetBasePath();
+    char *path = NULL;
+    if (SDL_asprintf(&path, "%s%s", base ? base : "", POLICY_FILE) < 0) {
+        return;
+    }
+
+    size_t size = 0;
+    unsigned char *blob = (unsigned char *)SDL_LoadFile(path, &size);
+    if (blob && policy_is_valid(blob, size)) {
+        app->policy = blob;
+    } else {
+        if (blob) {
+            printf("Ignoring invalid policy file: %s\n", path);
+        }
+        SDL_free(blob);
+    }
+    SDL_free(path);
+}
+
+static void update_title(AppState *app) {
+    SDL_SetWindowTitle(app->window, app->difficulty == DIFFICULTY_LEARNED ? "Tic Tac Toe - Learned" : "Tic Tac Toe");
+}
+
 static void draw_x(SDL_Renderer *renderer, int x, int y, int size) {
     SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE); // Red X
     int margin = size / 4;
@@ -443,6 +499,9 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
     app->selected_col = 1;
     app->start_time = SDL_GetTicks();
 
+    load_policy(app);
+    app->difficulty = DIFFICULTY_NORMAL;
+
     return SDL_APP_CONTINUE;
 }
 
@@ -486,6 +545,19 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
                         }
                         app->game_state = GAME_PLAYING;
                         break;
+                    case SDL_SCANCODE_D:
+                        // Switch difficulty and start a new game
+                        if (app->policy) {
+                            app->difficulty = app->difficulty == DIFFICULTY_LEARNED ? DIFFICULTY_NORMAL : DIFFICULTY_LEARNED;
+                            update_title(app);
+                            for (int i = 0; i < BOARD_SIZE; i++) {
+                                for (int j = 0; j < BOARD_SIZE; j++) {
+                                    app->board[i][j] = CELL_EMPTY;
+                                }
+                            }
+                            app->game_state = GAME_PLAYING;
+                        }
+                        break;
                 }
             } else {
                 // Game over, allow reset
@@ -625,6 +697,13 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
         draw_glow_effect(app->renderer, 30, 320, 420, 40, pulse, pulse, 255);
         draw_big_text(app->renderer, "PRESS R TO RESTART", 50, 330, 255, 255, 255, 2); // Always white text
         
+        // Show which opponent was played when there is a choice
+        if (app->policy) {
+            const char *label = app->difficulty == DIFFICULTY_LEARNED ? "LEARNED AI" : "NORMAL AI";
+            int label_width = (int)SDL_strlen(label) * 12;
+            draw_clean_text(app->renderer, label, (WINDOW_WIDTH - label_width) / 2, 390, 2, 200, 200, 200);
+        }
+        
         // Add some decorative border elements
         SDL_SetRenderDrawColor(app->renderer, 255, 255, 255, 200);
         for (int i = 0; i < 10; i++) {
@@ -651,6 +730,7 @@ void SDL_AppQuit(void *appstate, SDL_AppResult result) {
         if (app->window) {
             SDL_DestroyWindow(app->window);
         }
+        SDL_free(app->policy);
         SDL_free(app);
     }
     SDL_Quit();
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: 0BSD
+#ifndef TIC_TAC_TOE_POLICY_H
+#define TIC_TAC_TOE_POLICY_H
+
+#include <stddef.h>
+
+// Learned policy blob, written by tic_tac_toe_train and loaded by the game.
+//
+// Layout (little-endian):
+//   bytes 0..3   magic "TTTP"
+//   byte  4      format version
+//   byte  5      number of cells (9)
+//   bytes 6..7   reserved, zero
+//   bytes 8..11  number of states (3^9)
+//   bytes 12..   one nibble per state, low nibble first: best cell 0-8
+//                (row * 3 + col) for the side to move, or 0xF if none
+//
+// A state is the board encoded in base 3, cell 0 being the least
+// significant digit, using the CellState values (0 empty, 1 X, 2 O).
+
+#define POLICY_MAGIC "TTTP"
+#define POLICY_VERSION 1
+#define POLICY_CELLS 9
+#define POLICY_STATES 19683
+#define POLICY_HEADER_SIZE 12
+#define POLICY_SIZE (POLICY_HEADER_SIZE + (POLICY_STATES + 1) / 2)
+#define POLICY_NO_MOVE 0xF
+
+static inline int policy_is_valid(const unsigned char *blob, size_t size) {
+    if (!blob || size != POLICY_SIZE) {
+        return 0;
+    }
+    unsigned long states = (unsigned long)blob[8] | ((unsigned long)blob[9] << 8) |
+                           ((unsigned long)blob[10] << 16) | ((unsigned long)blob[11] << 24);
+    return blob[0] == POLICY_MAGIC[0] && blob[1] == POLICY_MAGIC[1] &&
+           blob[2] == POLICY_MAGIC[2] && blob[3] == POLICY_MAGIC[3] &&
+           blob[4] == POLICY_VERSION && blob[5] == POLICY_CELLS &&
+           states == POLICY_STATES;
+}
+
+// Returns the stored cell (0-8) for a state, or POLICY_NO_MOVE
+static inline int policy_lookup(const unsigned char *blob, unsigned int state) {
+    unsigned char packed = blob[POLICY_HEADER_SIZE + state / 2];
+    return (state & 1) ? (packed >> 4) : (packed & 0x0F);
+}
+
+#endif // TIC_TAC_TOE_POLICY_H
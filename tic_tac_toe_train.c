@@ -0,0 +1,488 @@
+// SPDX-License-Identifier: 0BSD
+//
+// Self-play trainer for the learned difficulty level.
+//
+// Several threads play epsilon-greedy episodes against one shared Q table
+// using tabular Q-learning in negamax form: every value is from the point of
+// view of the side to move, so a move is worth the negated best value of the
+// position it hands to the opponent. Positions are reduced to one canonical
+// representative per symmetry class (rotations and mirrors), which shrinks
+// the table and lets every episode teach all eight orientations at once.
+//
+// Values are 16.16 fixed point so threads can update them with a plain
+// atomic add instead of locks; a lost race only costs a slightly stale
+// target, which tabular TD tolerates.
+//
+// Desktop build:
+//   cc -O2 -std=c11 -pthread tic_tac_toe_train.c -o tic_tac_toe_train
+//   ./tic_tac_toe_train -S
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tic_tac_toe_policy.h"
+
+#define BOARD_CELLS 9
+#define STATES POLICY_STATES
+
+#define CELL_EMPTY 0
+#define CELL_X 1
+#define CELL_O 2
+
+#define OUTCOME_NONE 0
+#define OUTCOME_DRAW 3  // 1 and 2 mean X or O has won
+
+#define Q_ONE 65536  // 1.0 in 16.16 fixed point
+
+#define DEFAULT_EPISODES 1000000L
+#define DEFAULT_OUTPUT "storage_skel/tic_tac_toe_policy.bin"
+#define DEFAULT_ALPHA 0.2
+#define DEFAULT_DRAW_REWARD 0.0
+#define EPSILON_START 0.5
+#define EPSILON_END 0.05
+#define SCALING_EPISODES 250000L
+#define MAX_THREADS 64
+
+// The eight board symmetries; cell i of the transformed board is taken from
+// cell symmetries[k][i] of the original
+static const unsigned char symmetries[8][BOARD_CELLS] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8},  // identity
+    {6, 3, 0, 7, 4, 1, 8, 5, 2},  // rotate 90
+    {8, 7, 6, 5, 4, 3, 2, 1, 0},  // rotate 180
+    {2, 5, 8, 1, 4, 7, 0, 3, 6},  // rotate 270
+    {2, 1, 0, 5, 4, 3, 8, 7, 6},  // mirror columns
+    {6, 7, 8, 3, 4, 5, 0, 1, 2},  // mirror rows
+    {0, 3, 6, 1, 4, 7, 2, 5, 8},  // transpose
+    {8, 5, 2, 7, 4, 1, 6, 3, 0}   // anti-transpose
+};
+
+static const unsigned char lines[8][3] = {
+    {0, 1, 2}, {3, 4, 5}, {6, 7, 8},
+    {0, 3, 6}, {1, 4, 7}, {2, 5, 8},
+    {0, 4, 8}, {2, 4, 6}
+};
+
+static int pow3[BOARD_CELLS];
+
+// Per-state lookup tables, filled once by init_tables()
+static uint16_t canonical[STATES];
+static uint8_t canonical_sym[STATES];
+static uint16_t empty_mask[STATES];
+static uint8_t outcome[STATES];
+
+// Shared values, indexed by canonical state * 9 + cell in canonical orientation
+static _Atomic int32_t q_table[STATES * BOARD_CELLS];
+
+typedef struct {
+    int32_t alpha;        // learning rate, 16.16
+    int32_t draw_reward;  // 16.16
+} TrainConfig;
+
+typedef struct {
+    pthread_t thread;
+    const TrainConfig *config;
+    long episodes;
+    uint64_t rng;
+    char padding[64];  // keep neighbouring workers off the same cache line
+} Worker;
+
+static void decode(int state, unsigned char cells[BOARD_CELLS]) {
+    for (int i = 0; i < BOARD_CELLS; i++) {
+        cells[i] = state % 3;
+        state /= 3;
+    }
+}
+
+static void init_tables(void) {
+    pow3[0] = 1;
+    for (int i = 1; i < BOARD_CELLS; i++) {
+        pow3[i] = pow3[i - 1] * 3;
+    }
+
+    for (int state = 0; state < STATES; state++) {
+        unsigned char cells[BOARD_CELLS];
+        decode(state, cells);
+
+        // Lowest encoding over all orientations is the canonical one
+        int best = STATES;
+        int best_sym = 0;
+        for (int k = 0; k < 8; k++) {
+            int code = 0;
+            for (int i = 0; i < BOARD_CELLS; i++) {
+                code += cells[symmetries[k][i]] * pow3[i];
+            }
+            if (code < best) {
+                best = code;
+                best_sym = k;
+            }
+        }
+        canonical[state] = (uint16_t)best;
+        canonical_sym[state] = (uint8_t)best_sym;
+
+        uint16_t mask = 0;
+        for (int i = 0; i < BOARD_CELLS; i++) {
+            if (cells[i] == CELL_EMPTY) {
+                mask |= 1u << i;
+            }
+        }
+        empty_mask[state] = mask;
+
+        uint8_t result = mask ? OUTCOME_NONE : OUTCOME_DRAW;
+        for (int l = 0; l < 8; l++) {
+            unsigned char a = cells[lines[l][0]];
+            if (a != CELL_EMPTY && a == cells[lines[l][1]] && a == cells[lines[l][2]]) {
+                result = a;
+                break;
+            }
+        }
+        outcome[state] = result;
+    }
+}
+
+static void reset_q_table(void) {
+    for (int i = 0; i < STATES * BOARD_CELLS; i++) {
+        atomic_store_explicit(&q_table[i], 0, memory_order_relaxed);
+    }
+}
+
+static uint64_t next_random(uint64_t *rng) {
+    // xorshift64*
+    uint64_t x = *rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *rng = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static int32_t q_get(int state, int cell) {
+    return atomic_load_explicit(&q_table[state * BOARD_CELLS + cell], memory_order_relaxed);
+}
+
+// Best value for the side to move in a canonical, non-terminal state
+static int32_t best_value(int state) {
+    int32_t best = INT32_MIN;
+    for (unsigned mask = empty_mask[state]; mask; mask &= mask - 1) {
+        int32_t q = q_get(state, __builtin_ctz(mask));
+        if (q > best) {
+            best = q;
+        }
+    }
+    return best;
+}
+
+// Greedy cell in a canonical state, ties broken at random
+static int greedy_cell(int state, uint64_t *rng) {
+    int32_t best = INT32_MIN;
+    int choice = -1;
+    int ties = 0;
+    for (unsigned mask = empty_mask[state]; mask; mask &= mask - 1) {
+        int cell = __builtin_ctz(mask);
+        int32_t q = q_get(state, cell);
+        if (q > best) {
+            best = q;
+            choice = cell;
+            ties = 1;
+        } else if (q == best && next_random(rng) % ++ties == 0) {
+            choice = cell;
+        }
+    }
+    return choice;
+}
+
+static int random_cell(int state, uint64_t *rng) {
+    unsigned mask = empty_mask[state];
+    int pick = (int)(next_random(rng) % (uint64_t)__builtin_popcount(mask));
+    while (pick-- > 0) {
+        mask &= mask - 1;
+    }
+    return __builtin_ctz(mask);
+}
+
+static void play_episode(const TrainConfig *config, uint64_t *rng, uint32_t epsilon) {
+    // Episodes run directly in canonical space: the game is symmetric, so
+    // continuing from the representative is as good as the real board
+    int state = 0;
+    int mover = CELL_X;
+
+    for (;;) {
+        int cell = ((uint32_t)next_random(rng) < epsilon) ? random_cell(state, rng)
+                                                          : greedy_cell(state, rng);
+        int next = canonical[state + mover * pow3[cell]];
+
+        int32_t target;
+        int done = 1;
+        if (outcome[next] == mover) {
+            target = Q_ONE;
+        } else if (outcome[next] == OUTCOME_DRAW) {
+            target = config->draw_reward;
+        } else {
+            target = -best_value(next);
+            done = 0;
+        }
+
+        _Atomic int32_t *slot = &q_table[state * BOARD_CELLS + cell];
+        int32_t q = atomic_load_explicit(slot, memory_order_relaxed);
+        int32_t delta = (int32_t)(((int64_t)(target - q) * config->alpha) / Q_ONE);
+        atomic_fetch_add_explicit(slot, delta, memory_order_relaxed);
+
+        if (done) {
+            return;
+        }
+        state = next;
+        mover = CELL_X + CELL_O - mover;
+    }
+}
+
+static void *worker_main(void *arg) {
+    Worker *worker = (Worker *)arg;
+    // Exploration decays linearly from EPSILON_START to EPSILON_END; epsilon
+    // is kept as a threshold on a 32-bit random draw
+    double span = worker->episodes > 1 ? (double)(worker->episodes - 1) : 1.0;
+    for (long e = 0; e < worker->episodes; e++) {
+        double epsilon = EPSILON_START + (EPSILON_END - EPSILON_START) * (double)e / span;
+        play_episode(worker->config, &worker->rng, (uint32_t)(epsilon * 4294967295.0));
+    }
+    return NULL;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Trains a fresh table and returns the wall-clock time taken, or a negative
+// value if a thread could not be started
+static double train(const TrainConfig *config, long episodes, int threads, uint64_t seed) {
+    static Worker workers[MAX_THREADS];
+
+    reset_q_table();
+
+    double start = now_seconds();
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t].config = config;
+        workers[t].episodes = episodes / threads + (t < episodes % threads ? 1 : 0);
+        workers[t].rng = seed + 0x9E3779B97F4A7C15ULL * (uint64_t)(t + 1);
+        if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) != 0) {
+            fprintf(stderr, "Failed to start training thread %d\n", t);
+            break;
+        }
+        started++;
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    return started == threads ? elapsed : -1.0;
+}
+
+static void build_policy(unsigned char blob[POLICY_SIZE]) {
+    memset(blob, 0, POLICY_SIZE);
+    memcpy(blob, POLICY_MAGIC, 4);
+    blob[4] = POLICY_VERSION;
+    blob[5] = POLICY_CELLS;
+    blob[8] = STATES & 0xFF;
+    blob[9] = (STATES >> 8) & 0xFF;
+    blob[10] = (STATES >> 16) & 0xFF;
+    blob[11] = (STATES >> 24) & 0xFF;
+
+    for (int state = 0; state < STATES; state++) {
+        int move = POLICY_NO_MOVE;
+        if (outcome[state] == OUTCOME_NONE) {
+            // Pick deterministically in canonical space, then map the cell
+            // back to this board's orientation
+            int rep = canonical[state];
+            int32_t best = INT32_MIN;
+            for (unsigned mask = empty_mask[rep]; mask; mask &= mask - 1) {
+                int cell = __builtin_ctz(mask);
+                int32_t q = q_get(rep, cell);
+                if (q > best) {
+                    best = q;
+                    move = symmetries[canonical_sym[state]][cell];
+                }
+            }
+        }
+        unsigned char *packed = &blob[POLICY_HEADER_SIZE + state / 2];
+        *packed |= (state & 1) ? (unsigned char)(move << 4) : (unsigned char)move;
+    }
+}
+
+typedef struct {
+    long games;
+    long wins;
+    long draws;
+    long losses;
+} Evaluation;
+
+// Plays the policy as O, moving second like the game does, against every
+// possible sequence of X moves
+static void evaluate(const unsigned char *blob, int state, int mover, Evaluation *eval) {
+    if (mover == CELL_O) {
+        int cell = policy_lookup(blob, (unsigned int)state);
+        int next = state + CELL_O * pow3[cell];
+        if (outcome[next] == OUTCOME_NONE) {
+            evaluate(blob, next, CELL_X, eval);
+            return;
+        }
+        eval->games++;
+        if (outcome[next] == CELL_O) {
+            eval->wins++;
+        } else {
+            eval->draws++;
+        }
+        return;
+    }
+
+    for (unsigned mask = empty_mask[state]; mask; mask &= mask - 1) {
+        int next = state + CELL_X * pow3[__builtin_ctz(mask)];
+        if (outcome[next] == OUTCOME_NONE) {
+            evaluate(blob, next, CELL_O, eval);
+            continue;
+        }
+        eval->games++;
+        if (outcome[next] == CELL_X) {
+            eval->losses++;
+        } else {
+            eval->draws++;
+        }
+    }
+}
+
+static int write_policy(const char *path, const unsigned char *blob) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+    int ok = fwrite(blob, 1, POLICY_SIZE, file) == POLICY_SIZE;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        fprintf(stderr, "Failed to write %s\n", path);
+    }
+    return ok;
+}
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [-e episodes] [-t threads] [-a alpha] [-d draw_reward] [-o output] [-S]\n"
+            "  -e  self-play episodes (default %ld)\n"
+            "  -t  training threads (default: online CPUs, max %d)\n"
+            "  -a  learning rate (default %.2f)\n"
+            "  -d  reward for a draw, win is 1 (default %.2f)\n"
+            "  -o  policy output path (default %s)\n"
+            "  -S  report episodes/second for 1, 2, 4, ... threads before training\n",
+            program, DEFAULT_EPISODES, MAX_THREADS, DEFAULT_ALPHA, DEFAULT_DRAW_REWARD,
+            DEFAULT_OUTPUT);
+}
+
+static void report_scaling(const TrainConfig *config, int max_threads, uint64_t seed) {
+    printf("Scaling over %ld episodes:\n", SCALING_EPISODES);
+    printf("  threads  episodes/s  speedup\n");
+    double base = 0.0;
+    for (int threads = 1;; threads *= 2) {
+        if (threads > max_threads) {
+            threads = max_threads;
+        }
+        double elapsed = train(config, SCALING_EPISODES, threads, seed);
+        if (elapsed < 0.0) {
+            return;
+        }
+        double rate = (double)SCALING_EPISODES / elapsed;
+        if (threads == 1) {
+            base = rate;
+        }
+        printf("  %7d  %10.0f  %6.2fx\n", threads, rate, rate / base);
+        if (threads == max_threads) {
+            break;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    long episodes = DEFAULT_EPISODES;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = online > 0 ? (int)online : 1;
+    double alpha = DEFAULT_ALPHA;
+    double draw_reward = DEFAULT_DRAW_REWARD;
+    const char *output = DEFAULT_OUTPUT;
+    int scaling = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "e:t:a:d:o:Sh")) != -1) {
+        switch (opt) {
+            case 'e':
+                episodes = strtol(optarg, NULL, 10);
+                break;
+            case 't':
+                threads = atoi(optarg);
+                break;
+            case 'a':
+                alpha = strtod(optarg, NULL);
+                break;
+            case 'd':
+                draw_reward = strtod(optarg, NULL);
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'S':
+                scaling = 1;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+    if (episodes < 1 || threads < 1 || alpha <= 0.0 || alpha > 1.0 ||
+        draw_reward < -1.0 || draw_reward > 1.0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    TrainConfig config = {
+        .alpha = (int32_t)(alpha * Q_ONE),
+        .draw_reward = (int32_t)(draw_reward * Q_ONE)
+    };
+    uint64_t seed = (uint64_t)time(NULL) | 1;
+
+    init_tables();
+
+    if (scaling) {
+        report_scaling(&config, threads, seed);
+    }
+
+    printf("Training %ld episodes on %d thread%s\n", episodes, threads, threads == 1 ? "" : "s");
+    double elapsed = train(&config, episodes, threads, seed);
+    if (elapsed < 0.0) {
+        return EXIT_FAILURE;
+    }
+    printf("Trained in %.2f s (%.0f episodes/s)\n", elapsed, (double)episodes / elapsed);
+
+    static unsigned char blob[POLICY_SIZE];
+    build_policy(blob);
+
+    Evaluation eval = {0};
+    evaluate(blob, 0, CELL_X, &eval);
+    printf("Policy as O against every X line: %ld games, %ld won, %ld drawn, %ld lost\n",
+           eval.games, eval.wins, eval.draws, eval.losses);
+
+    if (!write_policy(output, blob)) {
+        return EXIT_FAILURE;
+    }
+    printf("Wrote %s (%d bytes)\n", output, POLICY_SIZE);
+
+    return EXIT_SUCCESS;
+}